@@ -0,0 +1,328 @@
+// Host emulator of a ComfoAir unit on a simulated serial line, runs the component against it.
+//
+//   g++ -std=c++20 -O1 -I tools/emulator -I zehnder_comfoair tools/emulator/emulator.cpp zehnder_comfoair/zehnder_comfoair.cpp -o comfoair_emulator
+//   ./comfoair_emulator [--depth N] [--drop CMD] [--unsolicited] [--fifo BYTES] [--idle MINUTES] [--telemetry]
+//
+// The unit handles one frame at a time: after a fixed latency it sends the ACK and then the response.
+// Time is simulated, every loop() call advances the clock by 1 ms.
+
+#include "zehnder_comfoair.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace esphome;
+
+namespace {
+
+constexpr uint32_t BAUD_RATE = 9600;
+constexpr uint64_t BYTE_US = 1000000 * 10 / BAUD_RATE;
+// Time the unit needs before it replies to a frame
+constexpr uint64_t UNIT_LATENCY_US = 30000;
+constexpr uint64_t LOOP_STEP_US = 1000;
+
+struct Options {
+  int depth = 0;
+  int drop_cmd = -1;
+  bool unsolicited = false;
+  size_t fifo = 128;
+  uint32_t idle_minutes = 0;
+  bool telemetry = false;
+};
+
+Options options;
+uint64_t now_us = 0;
+
+// Heap allocations made by the component, the emulated line does not count
+size_t allocations = 0;
+bool in_line = false;
+
+struct TimedByte {
+  uint64_t at;
+  uint8_t byte;
+};
+
+// Bytes from the unit with their arrival time
+std::deque<TimedByte> rx;
+// Bytes received by the unit since the last complete message
+std::vector<uint8_t> unit_in;
+uint64_t unit_busy_until = 0;
+// Time our TX line finishes sending what was written
+uint64_t tx_line_free = 0;
+uint64_t tx_blocked_us = 0;
+int unit_acks = 0;
+
+void reset_line() {
+  rx.clear();
+  unit_in.clear();
+  now_us = 0;
+  unit_busy_until = 0;
+  tx_line_free = 0;
+  tx_blocked_us = 0;
+  unit_acks = 0;
+}
+
+std::vector<uint8_t> response_data(uint16_t cmd) {
+  size_t size = 0;
+  switch (cmd) {
+    case 0x000B: size = 6; break;
+    case 0x000D: size = 4; break;
+    case 0x00CD: size = 14; break;
+    case 0x00D1: size = 9; break;
+    case 0x00D9: size = 17; break;
+    case 0x00DD: size = 20; break;
+    case 0x00DF: size = 7; break;
+  }
+
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i) data[i] = 60 + i;
+  if (cmd == 0x00D1) {
+    // Comfort 21 C, outside 0 C, supply 16 C, extract 20 C, exhaust 2.5 C, all sensors present
+    data = {82, 40, 72, 80, 45, 0x0F, 0, 0, 0};
+  }
+  if (cmd == 0x000B) {
+    // Escape bytes in the payload
+    data[2] = 0x07;
+    data[3] = 0x07;
+  }
+  return data;
+}
+
+void unit_send(const std::vector<uint8_t>& bytes, uint64_t at) {
+  uint64_t t = std::max(at, rx.empty() ? 0 : rx.back().at);
+  for (auto b : bytes) {
+    t += BYTE_US;
+    rx.push_back({t, b});
+  }
+  unit_busy_until = t;
+}
+
+void unit_reply(uint16_t cmd, uint64_t at) {
+  if (static_cast<int>(cmd) == options.drop_cmd) return;
+  if (options.unsolicited && cmd == 0x000D) {
+    // A response nobody asked for comes first
+    unit_reply(0x00CD, at);
+  }
+
+  uint64_t start = std::max(at, unit_busy_until) + UNIT_LATENCY_US;
+  unit_send({0x07, 0xF3}, start);
+
+  auto data = response_data(cmd);
+  if (data.empty()) return;
+
+  uint16_t response_cmd = cmd + 1;
+  std::vector<uint8_t> frame = {0x07, 0xF0, uint8_t(response_cmd >> 8), uint8_t(response_cmd), uint8_t(data.size())};
+  uint8_t cksum = 173 + (response_cmd >> 8) + (response_cmd & 0xFF) + data.size();
+  for (auto b : data) {
+    frame.push_back(b);
+    cksum += b;
+    if (b == 0x07) frame.push_back(0x07);
+  }
+  frame.insert(frame.end(), {cksum, 0x07, 0x0F});
+  unit_send(frame, unit_busy_until);
+}
+
+void unit_receive(uint8_t byte, uint64_t at) {
+  unit_in.push_back(byte);
+  size_t n = unit_in.size();
+  if (n < 2 || unit_in[n - 2] != 0x07) return;
+
+  if (unit_in[n - 1] == 0xF3) {
+    ++unit_acks;
+    unit_in.clear();
+  } else if (unit_in[n - 1] == 0x0F) {
+    for (size_t i = 0; i + 3 < n; ++i) {
+      if (unit_in[i] == 0x07 && unit_in[i + 1] == 0xF0) {
+        unit_reply((unit_in[i + 2] << 8) | unit_in[i + 3], at);
+        break;
+      }
+    }
+    unit_in.clear();
+  }
+}
+
+struct TestComponent : zehnder_comfoair::ZehnderComfoAirComponent {
+  uart::UARTComponent uart;
+  sensor::Sensor outside, supply, extract, exhaust, efficiency, fan_duty, fan_speed, bypass;
+  sensor::Sensor bypass_factor, fault_ea, filter_hours;
+  binary_sensor::BinarySensor filter_full;
+
+  TestComponent() {
+    this->parent_ = &this->uart;
+    this->set_outside_temperature_sensor(&this->outside);
+    this->set_supply_temperature_sensor(&this->supply);
+    this->set_extract_temperature_sensor(&this->extract);
+    this->set_exhaust_temperature_sensor(&this->exhaust);
+    this->set_heat_recovery_efficiency_sensor(&this->efficiency);
+    this->set_supply_fan_duty_sensor(&this->fan_duty);
+    this->set_supply_fan_speed_sensor(&this->fan_speed);
+    this->set_bypass_status_sensor(&this->bypass);
+    this->set_bypass_factor_sensor(&this->bypass_factor);
+    this->set_fault_ea_sensor(&this->fault_ea);
+    this->set_filter_hours_sensor(&this->filter_hours);
+    this->set_filter_full_binary_sensor(&this->filter_full);
+  }
+};
+
+void run_for(TestComponent& c, uint64_t duration_us) {
+  for (uint64_t end = now_us + duration_us; now_us < end;) {
+    now_us += LOOP_STEP_US;
+    c.loop();
+  }
+}
+
+// Runs until the line has been quiet for longer than any timeout of the component
+void run_until_idle(TestComponent& c) {
+  while (!rx.empty() || now_us < tx_line_free + 12000000) {
+    now_us += LOOP_STEP_US;
+    c.loop();
+  }
+}
+
+void run_polls(int depth) {
+  reset_line();
+  TestComponent c;
+  c.set_pipeline_depth(depth);
+  c.setup();
+
+  printf("--- pipeline depth %d\n", depth);
+  for (int i = 0; i < 3; ++i) {
+    c.update();
+  }
+  c.update_diagnostics();
+  run_until_idle(c);
+
+  if (options.idle_minutes > 0) {
+    // Nothing is written for a while, then one more poll cycle
+    now_us += static_cast<uint64_t>(options.idle_minutes) * 60000000;
+    printf("--- after %" PRIu32 " minutes idle\n", options.idle_minutes);
+    c.update();
+    run_until_idle(c);
+  }
+
+  printf("supply fan %.0f rpm, outside %.1f C, supply %.1f C, extract %.1f C, exhaust %.1f C, "
+         "efficiency %.0f %%, bypass %.0f\n",
+         c.fan_speed.state, c.outside.state, c.supply.state, c.extract.state, c.exhaust.state, c.efficiency.state,
+         c.bypass.state);
+  printf("bypass factor %.0f, fault EA %.0f, filter hours %.0f\n", c.bypass_factor.state, c.fault_ea.state,
+         c.filter_hours.state);
+  printf("unit received %d ACKs, %llu us blocked in TX\n", unit_acks, static_cast<unsigned long long>(tx_blocked_us));
+}
+
+void run_telemetry_session() {
+  reset_line();
+  TestComponent c;
+  c.set_pipeline_depth(options.depth > 0 ? options.depth : 2);
+  c.set_telemetry_interval(200);
+  c.setup();
+
+  c.start_telemetry(10000);
+  // The first sample allocates the coroutine frames, later ones reuse them
+  run_for(c, 1000000);
+  auto before = allocations;
+  run_for(c, 8000000);
+  auto samples_allocations = allocations - before;
+  run_until_idle(c);
+
+  printf("%zu heap allocations during 40 samples\n", samples_allocations);
+}
+
+bool parse_options(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--depth" && has_value) {
+      options.depth = std::atoi(argv[++i]);
+    } else if (arg == "--drop" && has_value) {
+      options.drop_cmd = std::strtol(argv[++i], nullptr, 0);
+    } else if (arg == "--unsolicited") {
+      options.unsolicited = true;
+    } else if (arg == "--fifo" && has_value) {
+      options.fifo = std::atoi(argv[++i]);
+    } else if (arg == "--idle" && has_value) {
+      options.idle_minutes = std::atoi(argv[++i]);
+    } else if (arg == "--telemetry") {
+      options.telemetry = true;
+    } else {
+      printf("Usage: %s [--depth N] [--drop CMD] [--unsolicited] [--fifo BYTES] [--idle MINUTES] [--telemetry]\n",
+             argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+void *operator new(size_t size) {
+  if (!in_line) ++allocations;
+  if (void *ptr = std::malloc(size)) return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+uint32_t esphome::millis() { return now_us / 1000; }
+uint32_t esphome::micros() { return now_us; }
+
+uint32_t uart::UARTComponent::get_baud_rate() const { return BAUD_RATE; }
+
+void uart::UARTDevice::write_array(const uint8_t *data, size_t len) {
+  in_line = true;
+  uint64_t t = std::max(tx_line_free, now_us);
+  for (size_t i = 0; i < len; ++i) {
+    t += BYTE_US;
+    unit_receive(data[i], t);
+  }
+  tx_line_free = t;
+
+  // Whatever does not fit into the hardware FIFO blocks the caller
+  if (tx_line_free > now_us + options.fifo * BYTE_US) {
+    auto unblocked_at = tx_line_free - options.fifo * BYTE_US;
+    tx_blocked_us += unblocked_at - now_us;
+    now_us = unblocked_at;
+  }
+  in_line = false;
+}
+
+int uart::UARTDevice::available() {
+  int n = 0;
+  for (auto& b : rx) {
+    if (b.at > now_us) break;
+    ++n;
+  }
+  return n;
+}
+
+bool uart::UARTDevice::read_array(uint8_t *data, size_t len) {
+  if (static_cast<size_t>(this->available()) < len) return false;
+  for (size_t i = 0; i < len; ++i) {
+    data[i] = rx.front().byte;
+    rx.pop_front();
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (!parse_options(argc, argv)) return 1;
+
+  if (options.telemetry) {
+    run_telemetry_session();
+    return 0;
+  }
+
+  if (options.depth > 0) {
+    run_polls(options.depth);
+  } else {
+    for (int depth = 1; depth <= 4; ++depth) {
+      run_polls(depth);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace esphome {
+namespace sensor {
+
+class Sensor {
+ public:
+  void publish_state(float state) { this->state = state; }
+  bool has_state() const { return true; }
+
+  float state{0};
+};
+
+}  // namespace sensor
+}  // namespace esphome
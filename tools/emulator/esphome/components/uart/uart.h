@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace uart {
+
+class UARTComponent {
+ public:
+  uint32_t get_baud_rate() const;
+};
+
+// Implemented by the emulated line in emulator.cpp
+class UARTDevice {
+ public:
+  void write_byte(uint8_t data) { this->write_array(&data, 1); }
+  void write_array(const uint8_t *data, size_t len);
+  bool read_byte(uint8_t *data) { return this->read_array(data, 1); }
+  bool read_array(uint8_t *data, size_t len);
+  int available();
+
+ protected:
+  UARTComponent *parent_{nullptr};
+};
+
+}  // namespace uart
+}  // namespace esphome
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+
+// Simulated clock of the emulator
+uint32_t millis();
+uint32_t micros();
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+};
+
+class PollingComponent : public Component {
+ public:
+  virtual void update() = 0;
+};
+
+}  // namespace esphome
@@ -0,0 +1,27 @@
+#pragma once
+// Stands in for the defines.h ESPHome generates, this is the configuration the emulator runs
+#define USE_SENSOR
+#define USE_BINARY_SENSOR
+
+#define USE_ZEHNDER_COMFOAIR_BYPASS_STATUS
+#define USE_ZEHNDER_COMFOAIR_OUTSIDE_TEMPERATURE
+#define USE_ZEHNDER_COMFOAIR_SUPPLY_TEMPERATURE
+#define USE_ZEHNDER_COMFOAIR_EXTRACT_TEMPERATURE
+#define USE_ZEHNDER_COMFOAIR_EXHAUST_TEMPERATURE
+#define USE_ZEHNDER_COMFOAIR_HEAT_RECOVERY_EFFICIENCY
+#define USE_ZEHNDER_COMFOAIR_SUPPLY_FAN_DUTY
+#define USE_ZEHNDER_COMFOAIR_SUPPLY_FAN_SPEED
+#define USE_ZEHNDER_COMFOAIR_FILTER_FULL
+#define USE_ZEHNDER_COMFOAIR_BYPASS_FACTOR
+#define USE_ZEHNDER_COMFOAIR_FAULT_EA
+#define USE_ZEHNDER_COMFOAIR_FILTER_HOURS
+
+#define USE_ZEHNDER_COMFOAIR_QUERY_TEMPERATURES
+#define USE_ZEHNDER_COMFOAIR_QUERY_FANS
+#define USE_ZEHNDER_COMFOAIR_QUERY_BYPASS_STATUS
+#define USE_ZEHNDER_COMFOAIR_QUERY_FAULTS
+#define USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_BYPASS_CONTROL
+#define USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_FAULTS
+#define USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_OPERATING_HOURS
+#define USE_ZEHNDER_COMFOAIR_DIAGNOSTICS
+#define USE_ZEHNDER_COMFOAIR_TELEMETRY
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdio>
+
+#include "esphome/core/component.h"
+
+#define ESP_LOG_HOST(level, format, ...) printf("[%6u ms] " level " " format "\n", esphome::millis(), ##__VA_ARGS__)
+#define ESP_LOGE(tag, format, ...) ((void) (tag), ESP_LOG_HOST("E", format, ##__VA_ARGS__))
+#define ESP_LOGW(tag, format, ...) ((void) (tag), ESP_LOG_HOST("W", format, ##__VA_ARGS__))
+#define ESP_LOGI(tag, format, ...) ((void) (tag), ESP_LOG_HOST("I", format, ##__VA_ARGS__))
+#define ESP_LOGD(tag, format, ...) ((void) (tag), ESP_LOG_HOST("D", format, ##__VA_ARGS__))
+#define ESP_LOGV(tag, format, ...) ((void) (tag), ESP_LOG_HOST("V", format, ##__VA_ARGS__))
+#define ESP_LOGCONFIG(tag, format, ...) ((void) (tag), ESP_LOG_HOST("C", format, ##__VA_ARGS__))
@@ -0,0 +1,85 @@
+// Host microbenchmark of temperature decoding and comparison, float math versus the fixed point Temperature type.
+//
+//   g++ -std=c++20 -O2 -I zehnder_comfoair tools/temperature_bench.cpp -o temperature_bench && ./temperature_bench
+//
+// A host FPU makes float math cheap, the fixed point path targets FPU-less chips such as the ESP32-C3,
+// so these numbers only show the host side of the trade-off.
+
+#include "temperature.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using esphome::zehnder_comfoair::Temperature;
+
+namespace {
+
+// Float conversion used before the Temperature type
+__attribute__((noinline)) float parse_float(uint8_t byte) {
+  int raw = byte;
+  if (raw >= 128) raw -= 256;
+
+  return static_cast<float>(raw) / 2 - 20;
+}
+
+__attribute__((noinline)) float parse_fixed(uint8_t byte) {
+  return Temperature::from_raw(byte).to_float();
+}
+
+// Read-back check of the comfort temperature against the number state
+__attribute__((noinline)) bool changed_float(uint8_t byte, float state) {
+  return parse_float(byte) != state;
+}
+
+__attribute__((noinline)) bool changed_fixed(uint8_t byte, Temperature state) {
+  return Temperature::from_raw(byte) != state;
+}
+
+template<class F>
+void run(const char *name, long iterations, F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  printf("%-14s %.2f ns/op\n", name, std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  long iterations = argc > 1 ? std::atol(argv[1]) : 50'000'000;
+
+  for (int raw = 0; raw < 256; ++raw) {
+    if (parse_float(raw) != parse_fixed(raw)) {
+      printf("Mismatch for raw byte %d: %.1f != %.1f\n", raw, parse_float(raw), parse_fixed(raw));
+      return 1;
+    }
+  }
+
+  volatile float float_sink = 0;
+  volatile int int_sink = 0;
+
+  run("decode float", iterations, [&] {
+    float acc = 0;
+    for (long i = 0; i < iterations; ++i) acc += parse_float(i);
+    float_sink = acc;
+  });
+  run("decode fixed", iterations, [&] {
+    float acc = 0;
+    for (long i = 0; i < iterations; ++i) acc += parse_fixed(i);
+    float_sink = acc;
+  });
+  run("compare float", iterations, [&] {
+    int acc = 0;
+    for (long i = 0; i < iterations; ++i) acc += changed_float(i, 20.5f);
+    int_sink = acc;
+  });
+  run("compare fixed", iterations, [&] {
+    int acc = 0;
+    auto state = Temperature::from_float(20.5f);
+    for (long i = 0; i < iterations; ++i) acc += changed_fixed(i, state);
+    int_sink = acc;
+  });
+
+  return 0;
+}
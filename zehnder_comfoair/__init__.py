@@ -1,23 +1,97 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome import automation
 from esphome.components import uart
 from esphome.const import (
+    CONF_DURATION,
     CONF_ID,
+    CONF_PLATFORM,
 )
 
 DEPENDENCIES = ["uart"]
 
+DOMAIN = "zehnder_comfoair"
+
 CONF_ZEHNDER_COMFOAIR_ID = "zehnder_comfoair_id"
+CONF_UPDATE_DIAGNOSTICS = "update_diagnostics"
+CONF_FILTER_FULL = "filter_full"
+CONF_PIPELINE_DEPTH = "pipeline_depth"
+CONF_TELEMETRY_INTERVAL = "telemetry_interval"
+
+# Datapoints queried during regular polling, see use_entity()
+QUERY_TEMPERATURES = "TEMPERATURES"
+QUERY_FANS = "FANS"
+QUERY_BYPASS_STATUS = "BYPASS_STATUS"
+QUERY_FAULTS = "FAULTS"
+
+# Datapoints queried only on request, see use_diagnostic_entity()
+DIAGNOSTIC_BYPASS_CONTROL = "BYPASS_CONTROL"
+DIAGNOSTIC_FAULTS = "FAULTS"
+DIAGNOSTIC_OPERATING_HOURS = "OPERATING_HOURS"
 
 zehnder_comfoair_ns = cg.esphome_ns.namespace("zehnder_comfoair")
 ZehnderComfoAirComponent = zehnder_comfoair_ns.class_(
     "ZehnderComfoAirComponent", cg.PollingComponent, uart.UARTDevice
 )
 
+def use_entity(key, query=None):
+    """Compile in the entity and the datapoint it is decoded from.
+
+    Everything the configuration does not use is left out of the poll plan,
+    so it costs neither bus time nor flash.
+    """
+    cg.add_define(f"USE_ZEHNDER_COMFOAIR_{key.upper()}")
+    if query is not None:
+        cg.add_define(f"USE_ZEHNDER_COMFOAIR_QUERY_{query}")
+
+def use_diagnostic_entity(key, datapoint):
+    """Compile in the entity and its datapoint, which is queried only on request."""
+    cg.add_define(f"USE_ZEHNDER_COMFOAIR_{key.upper()}")
+    cg.add_define(f"USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_{datapoint}")
+    cg.add_define("USE_ZEHNDER_COMFOAIR_DIAGNOSTICS")
+
+def _platform_configs(full_config, component, hub_id):
+    return [
+        conf for conf in full_config.get(component, [])
+        if conf.get(CONF_PLATFORM) == DOMAIN and conf[CONF_ZEHNDER_COMFOAIR_ID] == hub_id
+    ]
+
+def _has_update_diagnostics_action(value, hub_id):
+    if isinstance(value, dict):
+        action = value.get(f"{DOMAIN}.update_diagnostics")
+        if isinstance(action, dict) and action.get(CONF_ID) == hub_id:
+            return True
+        return any(_has_update_diagnostics_action(v, hub_id) for v in value.values())
+    if isinstance(value, list):
+        return any(_has_update_diagnostics_action(v, hub_id) for v in value)
+    return False
+
+def diagnostics_triggered(full_config, hub_id):
+    """Whether the update_diagnostics button or action is configured for the hub.
+
+    Calls from lambdas cannot be seen, so this is only good for a warning.
+    """
+    if any(CONF_UPDATE_DIAGNOSTICS in conf for conf in _platform_configs(full_config, "button", hub_id)):
+        return True
+    return _has_update_diagnostics_action(full_config, hub_id)
+
+def faults_polled(full_config, hub_id):
+    """Whether the faults datapoint is part of regular polling, it is with filter_full."""
+    return any(CONF_FILTER_FULL in conf for conf in _platform_configs(full_config, "binary_sensor", hub_id))
+
+StartTelemetryAction = zehnder_comfoair_ns.class_("StartTelemetryAction", automation.Action)
+StopTelemetryAction = zehnder_comfoair_ns.class_("StopTelemetryAction", automation.Action)
+UpdateDiagnosticsAction = zehnder_comfoair_ns.class_("UpdateDiagnosticsAction", automation.Action)
+
 CONFIG_SCHEMA = (
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(ZehnderComfoAirComponent),
+            cv.Optional(CONF_PIPELINE_DEPTH, default=1): cv.int_range(min=1, max=4),
+            cv.Optional(CONF_TELEMETRY_INTERVAL, default="1s"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(milliseconds=200)),
+            ),
         }
     )
     .extend(cv.polling_component_schema("60s"))
@@ -28,3 +102,51 @@ async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
+
+    cg.add(var.set_pipeline_depth(config[CONF_PIPELINE_DEPTH]))
+    cg.add(var.set_telemetry_interval(config[CONF_TELEMETRY_INTERVAL]))
+
+HUB_ACTION_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.use_id(ZehnderComfoAirComponent),
+    }
+)
+
+@automation.register_action(
+    "zehnder_comfoair.start_telemetry",
+    StartTelemetryAction,
+    HUB_ACTION_SCHEMA.extend(
+        {
+            cv.Optional(CONF_DURATION, default="5min"): cv.templatable(cv.positive_time_period_milliseconds),
+        }
+    ),
+)
+async def start_telemetry_to_code(config, action_id, template_arg, args):
+    cg.add_define("USE_ZEHNDER_COMFOAIR_TELEMETRY")
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    duration = await cg.templatable(config[CONF_DURATION], args, cg.uint32)
+    cg.add(var.set_duration(duration))
+    return var
+
+@automation.register_action(
+    "zehnder_comfoair.stop_telemetry",
+    StopTelemetryAction,
+    HUB_ACTION_SCHEMA,
+)
+async def stop_telemetry_to_code(config, action_id, template_arg, args):
+    cg.add_define("USE_ZEHNDER_COMFOAIR_TELEMETRY")
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
+@automation.register_action(
+    "zehnder_comfoair.update_diagnostics",
+    UpdateDiagnosticsAction,
+    HUB_ACTION_SCHEMA,
+)
+async def update_diagnostics_to_code(config, action_id, template_arg, args):
+    cg.add_define("USE_ZEHNDER_COMFOAIR_DIAGNOSTICS")
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
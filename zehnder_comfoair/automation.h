@@ -0,0 +1,33 @@
+#pragma once
+
+#include "zehnder_comfoair.h"
+
+#include "esphome/core/automation.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace zehnder_comfoair {
+
+#ifdef USE_ZEHNDER_COMFOAIR_TELEMETRY
+template<typename... Ts> class StartTelemetryAction : public Action<Ts...>, public Parented<ZehnderComfoAirComponent> {
+public:
+  TEMPLATABLE_VALUE(uint32_t, duration)
+
+  void play(Ts... x) override { this->parent_->start_telemetry(this->duration_.value(x...)); }
+};
+
+template<typename... Ts> class StopTelemetryAction : public Action<Ts...>, public Parented<ZehnderComfoAirComponent> {
+public:
+  void play(Ts... x) override { this->parent_->stop_telemetry(); }
+};
+#endif
+
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTICS
+template<typename... Ts> class UpdateDiagnosticsAction : public Action<Ts...>, public Parented<ZehnderComfoAirComponent> {
+public:
+  void play(Ts... x) override { this->parent_->update_diagnostics(); }
+};
+#endif
+
+}  // namespace zehnder_comfoair
+}  // namespace esphome
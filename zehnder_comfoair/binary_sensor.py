@@ -5,12 +5,17 @@ from esphome.const import (
     DEVICE_CLASS_PROBLEM,
 )
 
-from . import CONF_ZEHNDER_COMFOAIR_ID, zehnder_comfoair_ns, ZehnderComfoAirComponent
+from . import (
+    CONF_FILTER_FULL,
+    CONF_ZEHNDER_COMFOAIR_ID,
+    QUERY_FAULTS,
+    zehnder_comfoair_ns,
+    ZehnderComfoAirComponent,
+    use_entity,
+)
 
 DEPENDENCIES = ["zehnder_comfoair"]
 
-CONF_FILTER_FULL = "filter_full"
-
 CONFIG_SCHEMA = (
     cv.Schema(
         {
@@ -23,13 +28,14 @@ CONFIG_SCHEMA = (
 )
 
 SENSOR_MAP = {
-    CONF_FILTER_FULL: "set_filter_full_binary_sensor",
+    CONF_FILTER_FULL: ("set_filter_full_binary_sensor", QUERY_FAULTS),
 }
 
 async def to_code(config):
     var = await cg.get_variable(config[CONF_ZEHNDER_COMFOAIR_ID])
 
-    for key, funcName in SENSOR_MAP.items():
+    for key, (funcName, query) in SENSOR_MAP.items():
         if key in config:
+            use_entity(key, query)
             sens = await binary_sensor.new_binary_sensor(config[key])
             cg.add(getattr(var, funcName)(sens))
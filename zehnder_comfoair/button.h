@@ -0,0 +1,19 @@
+#pragma once
+
+#ifdef USE_BUTTON
+#include "zehnder_comfoair.h"
+
+#include "esphome/components/button/button.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace zehnder_comfoair {
+
+class ZehnderComfoAirButton : public button::Button, public Parented<ZehnderComfoAirComponent> {
+protected:
+  void press_action() override;
+};
+
+}  // namespace zehnder_comfoair
+}  // namespace esphome
+#endif // USE_BUTTON
@@ -0,0 +1,37 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import button
+from esphome.const import (
+    ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+from . import CONF_UPDATE_DIAGNOSTICS, CONF_ZEHNDER_COMFOAIR_ID, zehnder_comfoair_ns, ZehnderComfoAirComponent
+
+DEPENDENCIES = ["zehnder_comfoair"]
+
+ICON_STETHOSCOPE = "mdi:stethoscope"
+
+ZehnderComfoAirButton = zehnder_comfoair_ns.class_(
+    "ZehnderComfoAirButton", button.Button
+)
+
+CONFIG_SCHEMA = (
+    cv.Schema(
+        {
+            cv.GenerateID(CONF_ZEHNDER_COMFOAIR_ID): cv.use_id(ZehnderComfoAirComponent),
+            cv.Optional(CONF_UPDATE_DIAGNOSTICS): button.button_schema(
+                ZehnderComfoAirButton,
+                icon=ICON_STETHOSCOPE,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+        }
+    )
+)
+
+async def to_code(config):
+    var = await cg.get_variable(config[CONF_ZEHNDER_COMFOAIR_ID])
+
+    if CONF_UPDATE_DIAGNOSTICS in config:
+        cg.add_define("USE_ZEHNDER_COMFOAIR_DIAGNOSTICS")
+        update_diagnostics = await button.new_button(config[CONF_UPDATE_DIAGNOSTICS])
+        await cg.register_parented(update_diagnostics, var)
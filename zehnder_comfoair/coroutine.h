@@ -1,9 +1,11 @@
 #pragma once
 
 #include <coroutine>
+#include <cstddef>
 #include <exception>
 #include <functional>
 #include <list>
+#include <new>
 
 namespace state_machine {
 
@@ -45,6 +47,50 @@ private:
     bool should_initialy_suspend_;
 };
 
+// Coroutine frames are recycled instead of returned to the heap, so a loop that keeps
+// awaiting the same coroutines only allocates during its first iteration.
+// Keeps the peak number of frames of each size, not thread safe.
+class FramePool {
+public:
+    static void* allocate(std::size_t size) {
+        if (size > MAX_POOLED_SIZE) return ::operator new(size);
+
+        auto& head = free_list(size);
+        if (head == nullptr) return ::operator new(round_up(size));
+
+        auto* block = head;
+        head = block->next;
+        return block;
+    }
+
+    static void deallocate(void* ptr, std::size_t size) {
+        if (size > MAX_POOLED_SIZE) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        auto& head = free_list(size);
+        head = new (ptr) Block{head};
+    }
+
+private:
+    struct Block {
+        Block* next;
+    };
+
+    static constexpr std::size_t GRANULARITY = 16;
+    static constexpr std::size_t MAX_POOLED_SIZE = 512;
+
+    static constexpr std::size_t round_up(std::size_t size) {
+        return (size + GRANULARITY - 1) / GRANULARITY * GRANULARITY;
+    }
+
+    static Block*& free_list(std::size_t size) {
+        static Block* free_lists[MAX_POOLED_SIZE / GRANULARITY] = {};
+        return free_lists[round_up(size) / GRANULARITY - 1];
+    }
+};
+
 template<class T>
 class Promise;
 
@@ -148,6 +194,9 @@ public:
     template<class This, class ...Args>
     Promise(This&&, Context& ctx, Args&&...): ctx_(ctx) {}
 
+    static void* operator new(std::size_t size) { return FramePool::allocate(size); }
+    static void operator delete(void* ptr, std::size_t size) { FramePool::deallocate(ptr, size); }
+
     Coroutine<T> get_return_object() {
         return Coroutine(std::coroutine_handle<Promise<T>>::from_promise(*this));
     }
@@ -243,6 +292,11 @@ public:
         return this->task_queue_.empty();
     }
 
+    // Number of tasks in the queue, including the running one
+    size_t size() const {
+        return this->task_queue_.size();
+    }
+
 private:
     std::list<Task> task_queue_;
     //size_t size_limit_ = 16;
@@ -7,7 +7,13 @@ from esphome.const import (
     UNIT_CELSIUS,
 )
 
-from . import CONF_ZEHNDER_COMFOAIR_ID, zehnder_comfoair_ns, ZehnderComfoAirComponent
+from . import (
+    CONF_ZEHNDER_COMFOAIR_ID,
+    QUERY_TEMPERATURES,
+    zehnder_comfoair_ns,
+    ZehnderComfoAirComponent,
+    use_entity,
+)
 
 DEPENDENCIES = ["zehnder_comfoair"]
 
@@ -42,8 +48,11 @@ async def to_code(config):
     var = await cg.get_variable(config[CONF_ZEHNDER_COMFOAIR_ID])
 
     if CONF_LEVEL in config:
+        use_entity(CONF_LEVEL)
         level = await number.new_number(config[CONF_LEVEL], min_value=1, max_value=3, step=1)
         cg.add(getattr(var, "set_level_number")(level))
     if CONF_COMFORT_TEMPERATURE in config:
+        # Current comfort temperature is read back with the temperatures
+        use_entity(CONF_COMFORT_TEMPERATURE, QUERY_TEMPERATURES)
         comfort_temperature = await number.new_number(config[CONF_COMFORT_TEMPERATURE], min_value=12, max_value=28, step=0.5)
         cg.add(getattr(var, "set_comfort_temperature_number")(comfort_temperature))
@@ -1,14 +1,39 @@
+import logging
+
 import esphome.codegen as cg
 import esphome.config_validation as cv
+import esphome.final_validate as fv
 from esphome.components import sensor
 from esphome.const import (
+    DEVICE_CLASS_DURATION,
     DEVICE_CLASS_TEMPERATURE,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    ICON_FAN,
     STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
     UNIT_CELSIUS,
+    UNIT_HOUR,
     UNIT_PERCENT,
+    UNIT_REVOLUTIONS_PER_MINUTE,
+)
+
+from . import (
+    CONF_ZEHNDER_COMFOAIR_ID,
+    DIAGNOSTIC_BYPASS_CONTROL,
+    DIAGNOSTIC_FAULTS,
+    DIAGNOSTIC_OPERATING_HOURS,
+    QUERY_BYPASS_STATUS,
+    QUERY_FANS,
+    QUERY_TEMPERATURES,
+    zehnder_comfoair_ns,
+    ZehnderComfoAirComponent,
+    diagnostics_triggered,
+    faults_polled,
+    use_diagnostic_entity,
+    use_entity,
 )
 
-from . import CONF_ZEHNDER_COMFOAIR_ID, zehnder_comfoair_ns, ZehnderComfoAirComponent
+_LOGGER = logging.getLogger(__name__)
 
 DEPENDENCIES = ["zehnder_comfoair"]
 
@@ -17,8 +42,22 @@ CONF_OUTSIDE_TEMPERATURE = "outside_temperature"
 CONF_SUPPLY_TEMPERATURE = "supply_temperature"
 CONF_EXTRACT_TEMPERATURE = "extract_temperature"
 CONF_EXHAUST_TEMPERATURE = "exhaust_temperature"
+CONF_HEAT_RECOVERY_EFFICIENCY = "heat_recovery_efficiency"
+CONF_SUPPLY_FAN_DUTY = "supply_fan_duty"
+CONF_EXHAUST_FAN_DUTY = "exhaust_fan_duty"
+CONF_SUPPLY_FAN_SPEED = "supply_fan_speed"
+CONF_EXHAUST_FAN_SPEED = "exhaust_fan_speed"
+CONF_BYPASS_FACTOR = "bypass_factor"
+CONF_FAULT_A = "fault_a"
+CONF_FAULT_E = "fault_e"
+CONF_FAULT_EA = "fault_ea"
+CONF_FAULT_A_HIGH = "fault_a_high"
+CONF_FILTER_HOURS = "filter_hours"
 
+ICON_AIR_FILTER = "mdi:air-filter"
+ICON_ALERT_CIRCLE_OUTLINE = "mdi:alert-circle-outline"
 ICON_CALL_SPLIT = "mdi:call-split"
+ICON_HEAT_WAVE = "mdi:heat-wave"
 ICON_HOME_EXPORT_OUTLINE = "mdi:home-export-outline"
 ICON_HOME_IMPORT_OUTLINE = "mdi:home-import-outline"
 ICON_HOME_LOCATION_ENTER = "mdi:location-enter"
@@ -62,22 +101,124 @@ CONFIG_SCHEMA = (
                 device_class=DEVICE_CLASS_TEMPERATURE,
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
+            cv.Optional(CONF_HEAT_RECOVERY_EFFICIENCY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                icon=ICON_HEAT_WAVE,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_SUPPLY_FAN_DUTY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                icon=ICON_FAN,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_EXHAUST_FAN_DUTY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                icon=ICON_FAN,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_SUPPLY_FAN_SPEED): sensor.sensor_schema(
+                unit_of_measurement=UNIT_REVOLUTIONS_PER_MINUTE,
+                icon=ICON_FAN,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_EXHAUST_FAN_SPEED): sensor.sensor_schema(
+                unit_of_measurement=UNIT_REVOLUTIONS_PER_MINUTE,
+                icon=ICON_FAN,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_BYPASS_FACTOR): sensor.sensor_schema(
+                icon=ICON_CALL_SPLIT,
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_FAULT_A): sensor.sensor_schema(
+                icon=ICON_ALERT_CIRCLE_OUTLINE,
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_FAULT_E): sensor.sensor_schema(
+                icon=ICON_ALERT_CIRCLE_OUTLINE,
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_FAULT_EA): sensor.sensor_schema(
+                icon=ICON_ALERT_CIRCLE_OUTLINE,
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_FAULT_A_HIGH): sensor.sensor_schema(
+                icon=ICON_ALERT_CIRCLE_OUTLINE,
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_FILTER_HOURS): sensor.sensor_schema(
+                unit_of_measurement=UNIT_HOUR,
+                icon=ICON_AIR_FILTER,
+                accuracy_decimals=0,
+                device_class=DEVICE_CLASS_DURATION,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
         }
     )
 )
 
 SENSOR_MAP = {
-    CONF_BYPASS_STATUS: "set_bypass_status_sensor",
-    CONF_OUTSIDE_TEMPERATURE: "set_outside_temperature_sensor",
-    CONF_SUPPLY_TEMPERATURE: "set_supply_temperature_sensor",
-    CONF_EXTRACT_TEMPERATURE: "set_extract_temperature_sensor",
-    CONF_EXHAUST_TEMPERATURE: "set_exhaust_temperature_sensor",
+    CONF_BYPASS_STATUS: ("set_bypass_status_sensor", QUERY_BYPASS_STATUS),
+    CONF_OUTSIDE_TEMPERATURE: ("set_outside_temperature_sensor", QUERY_TEMPERATURES),
+    CONF_SUPPLY_TEMPERATURE: ("set_supply_temperature_sensor", QUERY_TEMPERATURES),
+    CONF_EXTRACT_TEMPERATURE: ("set_extract_temperature_sensor", QUERY_TEMPERATURES),
+    CONF_EXHAUST_TEMPERATURE: ("set_exhaust_temperature_sensor", QUERY_TEMPERATURES),
+    CONF_HEAT_RECOVERY_EFFICIENCY: ("set_heat_recovery_efficiency_sensor", QUERY_TEMPERATURES),
+    CONF_SUPPLY_FAN_DUTY: ("set_supply_fan_duty_sensor", QUERY_FANS),
+    CONF_EXHAUST_FAN_DUTY: ("set_exhaust_fan_duty_sensor", QUERY_FANS),
+    CONF_SUPPLY_FAN_SPEED: ("set_supply_fan_speed_sensor", QUERY_FANS),
+    CONF_EXHAUST_FAN_SPEED: ("set_exhaust_fan_speed_sensor", QUERY_FANS),
+}
+
+DIAGNOSTIC_SENSOR_MAP = {
+    CONF_BYPASS_FACTOR: ("set_bypass_factor_sensor", DIAGNOSTIC_BYPASS_CONTROL),
+    CONF_FAULT_A: ("set_fault_a_sensor", DIAGNOSTIC_FAULTS),
+    CONF_FAULT_E: ("set_fault_e_sensor", DIAGNOSTIC_FAULTS),
+    CONF_FAULT_EA: ("set_fault_ea_sensor", DIAGNOSTIC_FAULTS),
+    CONF_FAULT_A_HIGH: ("set_fault_a_high_sensor", DIAGNOSTIC_FAULTS),
+    CONF_FILTER_HOURS: ("set_filter_hours_sensor", DIAGNOSTIC_OPERATING_HOURS),
 }
 
+def _final_validate(config):
+    full_config = fv.full_config.get()
+    hub_id = config[CONF_ZEHNDER_COMFOAIR_ID]
+    if diagnostics_triggered(full_config, hub_id):
+        return config
+
+    polled = {DIAGNOSTIC_FAULTS} if faults_polled(full_config, hub_id) else set()
+    for key, (_, datapoint) in DIAGNOSTIC_SENSOR_MAP.items():
+        if key in config and datapoint not in polled:
+            _LOGGER.warning(
+                "Sensor '%s' is queried only by the update_diagnostics button or action, "
+                "configure one of them or it stays unknown",
+                key,
+            )
+    return config
+
+FINAL_VALIDATE_SCHEMA = _final_validate
+
 async def to_code(config):
     var = await cg.get_variable(config[CONF_ZEHNDER_COMFOAIR_ID])
 
-    for key, funcName in SENSOR_MAP.items():
+    for key, (funcName, query) in SENSOR_MAP.items():
+        if key in config:
+            use_entity(key, query)
+            sens = await sensor.new_sensor(config[key])
+            cg.add(getattr(var, funcName)(sens))
+
+    for key, (funcName, datapoint) in DIAGNOSTIC_SENSOR_MAP.items():
         if key in config:
+            use_diagnostic_entity(key, datapoint)
             sens = await sensor.new_sensor(config[key])
             cg.add(getattr(var, funcName)(sens))
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace zehnder_comfoair {
+
+// Protocol byte is a signed offset from -20°C in half degrees
+inline constexpr int16_t TEMPERATURE_RAW_OFFSET = 40;
+
+constexpr std::array<float, 256> make_temperature_float_table() {
+  std::array<float, 256> table{};
+  for (int raw = 0; raw < 256; ++raw) {
+    table[raw] = static_cast<float>(static_cast<int8_t>(raw) - TEMPERATURE_RAW_OFFSET) / 2;
+  }
+  return table;
+}
+
+// Decoding every protocol byte ahead of time spares the soft-float division on chips without FPU
+inline constexpr std::array<float, 256> TEMPERATURE_FLOAT_TABLE = make_temperature_float_table();
+
+// Temperature in half degrees Celsius, the resolution the unit works with.
+// All the math is done on integers, floats appear only when publishing or reading entity states.
+class Temperature {
+public:
+  constexpr Temperature() = default;
+
+  static constexpr Temperature from_raw(uint8_t raw) { return Temperature(static_cast<int8_t>(raw) - TEMPERATURE_RAW_OFFSET); }
+  static Temperature from_float(float t) { return Temperature(static_cast<int16_t>(std::lround(t * 2))); }
+
+  constexpr uint8_t raw() const { return static_cast<uint8_t>(this->half_degrees_ + TEMPERATURE_RAW_OFFSET); }
+  float to_float() const { return TEMPERATURE_FLOAT_TABLE[this->raw()]; }
+
+  constexpr bool operator==(const Temperature& other) const { return this->half_degrees_ == other.half_degrees_; }
+  constexpr bool operator!=(const Temperature& other) const { return this->half_degrees_ != other.half_degrees_; }
+  constexpr int16_t operator-(const Temperature& other) const { return this->half_degrees_ - other.half_degrees_; }
+
+private:
+  explicit constexpr Temperature(int16_t half_degrees): half_degrees_(half_degrees) {}
+
+  int16_t half_degrees_ = 0;
+};
+
+}  // namespace zehnder_comfoair
+}  // namespace esphome
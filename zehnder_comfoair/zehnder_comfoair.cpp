@@ -2,9 +2,15 @@
 #ifdef USE_NUMBER
 #include "number.h"
 #endif
+#ifdef USE_BUTTON
+#include "button.h"
+#endif
 
 #include "esphome/core/log.h"
 
+#include <algorithm>
+#include <cinttypes>
+
 namespace esphome {
 namespace zehnder_comfoair {
 
@@ -19,34 +25,90 @@ static const uint8_t CODE_ACK = 0xF3;
 static const uint8_t CKSUM_INIT = 173;
 
 constexpr auto MAX_DATA_SIZE = 32;
-//constexpr auto MAX_MESSAGE_SIZE = 2 + 2 + 1 + MAX_DATA_SIZE * 2 + 1 + 2;
+constexpr auto MAX_MESSAGE_SIZE = 2 + 2 + 1 + MAX_DATA_SIZE * 2 + 1 + 2;
+
+// Hardware TX FIFO of the ESP32/ESP8266 UART, writing more than fits blocks the caller
+constexpr size_t TX_FIFO_SIZE = 128;
+// Start, data and stop bits
+constexpr uint32_t BITS_PER_BYTE = 10;
 
 constexpr uint8_t OUTSIDE_TEMP_MASK = 0x01;
 constexpr uint8_t SUPPLY_TEMP_MASK = 0x02;
 constexpr uint8_t EXTRACT_TEMP_MASK = 0x04;
 constexpr uint8_t EXHAUST_TEMP_MASK = 0x08;
 
-constexpr uint32_t READ_TIMEOUT_MS = 10000;
+// Minimal extract to outside difference for heat recovery efficiency, in half degrees
+constexpr int32_t EFFICIENCY_MIN_SPAN = 10;
+
+// The unit ACKs a query as soon as it is received, the response may take longer
+constexpr uint32_t ACK_TIMEOUT_MS = 1000;
+
+constexpr uint16_t CMD_FANS = 0x000B;
+constexpr uint16_t CMD_BYPASS_STATUS = 0x000D;
+constexpr uint16_t CMD_TEMPERATURES = 0x00D1;
+constexpr uint16_t CMD_FAULTS = 0x00D9;
+constexpr uint16_t CMD_OPERATING_HOURS = 0x00DD;
+constexpr uint16_t CMD_BYPASS_CONTROL = 0x00DF;
+
+constexpr uint8_t FANS_DATA_SIZE = 6;
+constexpr uint8_t BYPASS_STATUS_DATA_SIZE = 4;
+constexpr uint8_t TEMPERATURES_DATA_SIZE = 9;
+constexpr uint8_t FAULTS_DATA_SIZE = 17;
+constexpr uint8_t OPERATING_HOURS_DATA_SIZE = 20;
+constexpr uint8_t BYPASS_CONTROL_DATA_SIZE = 7;
+
+// Upper bound of queries in a regular poll cycle
+constexpr size_t MAX_POLL_QUERIES = 4;
+// Upper bound of queries in a diagnostics request
+constexpr size_t MAX_DIAGNOSTIC_QUERIES = 3;
+
+// Fan speed is reported as a period, rpm = FAN_SPEED_FACTOR / raw
+constexpr uint32_t FAN_SPEED_FACTOR = 1875000;
+
+// Query frames carry no data, so they can be built at compile time
+static constexpr std::array<uint8_t, 8> make_query_frame(uint16_t cmd) {
+  const uint8_t hi = cmd >> 8;
+  const uint8_t lo = cmd & 0xFF;
+  return {CODE_ESCAPE, CODE_START, hi, lo, 0, static_cast<uint8_t>(CKSUM_INIT + hi + lo), CODE_ESCAPE, CODE_END};
+}
+
+static constexpr auto FANS_QUERY_FRAME = make_query_frame(CMD_FANS);
+static constexpr auto BYPASS_STATUS_QUERY_FRAME = make_query_frame(CMD_BYPASS_STATUS);
+static constexpr auto TEMPERATURES_QUERY_FRAME = make_query_frame(CMD_TEMPERATURES);
+static constexpr auto FAULTS_QUERY_FRAME = make_query_frame(CMD_FAULTS);
+static constexpr auto OPERATING_HOURS_QUERY_FRAME = make_query_frame(CMD_OPERATING_HOURS);
+static constexpr auto BYPASS_CONTROL_QUERY_FRAME = make_query_frame(CMD_BYPASS_CONTROL);
 
 void ZehnderComfoAirComponent::setup() {
-#ifdef USE_NUMBER
-  this->level_number_->add_on_state_callback([this](float value) {
+  this->tx_byte_time_us_ = (1000000 * BITS_PER_BYTE + this->parent_->get_baud_rate() - 1) / this->parent_->get_baud_rate();
+
+#ifdef USE_ZEHNDER_COMFOAIR_LEVEL
+  if (this->level_number_ != nullptr) {
+    this->level_number_->add_on_state_callback([this](float value) {
+
+      this->task_queue.enqueue([this, value](Context& ctx) -> Coroutine<void> {
+        co_await this->apply_level(ctx, static_cast<uint8_t>(value));
+      });
 
-    this->task_queue.enqueue([this, value](Context& ctx) -> Coroutine<void> {
-      co_await this->apply_level(ctx, static_cast<uint8_t>(value));
     });
+  }
+#endif
 
-  });
+#ifdef USE_ZEHNDER_COMFOAIR_COMFORT_TEMPERATURE
+  if (this->comfort_temperature_number_ != nullptr) {
+    this->comfort_temperature_number_->add_on_state_callback([this](float value) {
+      // Converted once here, the number state is mirrored in fixed point for comparisons
+      auto t = Temperature::from_float(value);
+      this->comfort_temperature_ = t;
+      ++this->comfort_temperature_pending_updates_;
 
-  this->comfort_temperature_number_->add_on_state_callback([this](float value) {
-    ++this->comfort_temperature_pending_updates_;
+      this->task_queue.enqueue([this, t](Context& ctx) -> Coroutine<void> {
+        co_await this->apply_comfort_temperature(ctx, t);
+        --this->comfort_temperature_pending_updates_;
+      });
 
-    this->task_queue.enqueue([this, value](Context& ctx) -> Coroutine<void> {
-      co_await this->apply_comfort_temperature(ctx, value);
-      --this->comfort_temperature_pending_updates_;
     });
-
-  });
+  }
 #endif
 }
 
@@ -55,16 +117,73 @@ void ZehnderComfoAirComponent::loop() {
 }
 
 void ZehnderComfoAirComponent::update() {
+#ifdef USE_ZEHNDER_COMFOAIR_TELEMETRY
+  // Telemetry session already keeps the sensors fresh
+  if (this->is_telemetry_active()) {
+    return;
+  }
+#endif
+
   this->task_queue.enqueue([this](Context& ctx) -> Coroutine<void> {
-    co_await this->update_temperatures(ctx);
-    co_await this->update_bypass_status(ctx);
-    co_await this->update_faults(ctx);
+    co_await this->poll(ctx);
   });
 }
 
 void ZehnderComfoAirComponent::dump_config(){
   ESP_LOGCONFIG(TAG, "Zehnder ComfoAir component");
+  ESP_LOGCONFIG(TAG, "  Pipeline depth: %u", this->pipeline_depth_);
+  ESP_LOGCONFIG(TAG, "  Telemetry interval: %" PRIu32 " ms", this->telemetry_interval_);
+}
+
+#ifdef USE_ZEHNDER_COMFOAIR_TELEMETRY
+void ZehnderComfoAirComponent::start_telemetry(uint32_t duration) {
+#if !defined(USE_ZEHNDER_COMFOAIR_QUERY_FANS) && !defined(USE_ZEHNDER_COMFOAIR_QUERY_TEMPERATURES)
+  // Pausing regular polling would only stop the other sensors
+  ESP_LOGW(TAG, "Telemetry needs a fan or temperature entity, not starting");
+  return;
+#endif
+
+  ESP_LOGI(TAG, "Starting telemetry for %" PRIu32 " ms", duration);
+
+  this->telemetry_start_ = millis();
+  this->telemetry_duration_ = duration;
+  this->telemetry_enabled_ = true;
+  this->telemetry_has_sample_ = false;
+  this->telemetry_tx_blocked_us_ = 0;
+
+  if (this->telemetry_running_) {
+    return;
+  }
+
+  this->telemetry_running_ = true;
+  this->task_queue.enqueue([this](Context& ctx) -> Coroutine<void> {
+    co_await this->run_telemetry(ctx);
+  });
+}
+
+void ZehnderComfoAirComponent::stop_telemetry() {
+  this->telemetry_enabled_ = false;
+}
+
+bool ZehnderComfoAirComponent::is_telemetry_active() const {
+  return this->telemetry_enabled_ && millis() - this->telemetry_start_ < this->telemetry_duration_;
 }
+#endif
+
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTICS
+void ZehnderComfoAirComponent::update_diagnostics() {
+  // Repeated requests collapse into the one already queued
+  if (this->diagnostics_pending_) {
+    return;
+  }
+
+  this->diagnostics_pending_ = true;
+  this->task_queue.enqueue([this](Context& ctx) -> Coroutine<void> {
+    co_await this->poll_diagnostics(ctx);
+    this->diagnostics_pending_ = false;
+  });
+}
+#endif
 
 Coroutine<bool> ZehnderComfoAirComponent::send_command(Context& ctx, ZehnderComfoAirComponent::cmd_t cmd, const uint8_t *data, size_t data_len) {
   if (data_len > MAX_DATA_SIZE) {
@@ -74,46 +193,44 @@ Coroutine<bool> ZehnderComfoAirComponent::send_command(Context& ctx, ZehnderComf
 
   uint8_t cksum = CKSUM_INIT;
 
+  // Assemble the whole frame, so it can be written as the FIFO drains
+  std::array<uint8_t, MAX_MESSAGE_SIZE> buf;
+  size_t pos = 0;
+
   // start sequence
-  this->write_array(std::to_array<uint8_t>({CODE_ESCAPE, CODE_START}));
+  buf[pos++] = CODE_ESCAPE;
+  buf[pos++] = CODE_START;
 
   // command
-  {
-    std::array<uint8_t, sizeof(cmd_t)> cmd_buf;
-    for (size_t i = 0; i < sizeof(cmd_t); ++i) {
-      uint8_t b = (cmd >> (8*i)) & 0xFF;
-      cmd_buf[sizeof(cmd_t) - i - 1] = b;
-      cksum += b;
-    }
-    this->write_array(cmd_buf);
+  for (size_t i = 0; i < sizeof(cmd_t); ++i) {
+    uint8_t b = (cmd >> (8*(sizeof(cmd_t) - i - 1))) & 0xFF;
+    buf[pos++] = b;
+    cksum += b;
   }
 
   // data length
-  this->write_byte(data_len);
+  buf[pos++] = data_len;
   cksum += data_len;
 
   // data
-  if (data_len > 0) {
-    std::array<uint8_t, MAX_DATA_SIZE * 2> buf;
-
-    size_t pos = 0;
-    for (size_t i = 0; i < data_len; ++i) {
-      buf[pos++] = data[i];
-      cksum += data[i];
+  for (size_t i = 0; i < data_len; ++i) {
+    buf[pos++] = data[i];
+    cksum += data[i];
 
-      if (data[i] == CODE_ESCAPE) {
-          buf[pos++] = CODE_ESCAPE;
-      }
+    if (data[i] == CODE_ESCAPE) {
+        buf[pos++] = CODE_ESCAPE;
     }
-
-    this->write_array(buf.data(), pos);
   }
 
   // checksum
-  this->write_byte(cksum);
+  buf[pos++] = cksum;
 
   // end sequence
-  this->write_array(std::to_array<uint8_t>({CODE_ESCAPE, CODE_END}));
+  buf[pos++] = CODE_ESCAPE;
+  buf[pos++] = CODE_END;
+
+  co_await this->write_array_coro(ctx, buf.data(), pos);
+  ESP_LOGD(TAG, "Command %x: %" PRIu32 " us blocked in TX", cmd, this->take_tx_blocked_us());
 
   // ACK
   if (!co_await this->read_ack(ctx)) {
@@ -123,33 +240,145 @@ Coroutine<bool> ZehnderComfoAirComponent::send_command(Context& ctx, ZehnderComf
   co_return true;
 }
 
-Coroutine<int> ZehnderComfoAirComponent::read_response(Context& ctx, cmd_t cmd, uint8_t *data, uint8_t data_len) {
-  uint8_t cksum = CKSUM_INIT;
+Coroutine<size_t> ZehnderComfoAirComponent::query_pipelined(Context& ctx, Query *queries, size_t count) {
+  size_t sent = 0;
+  size_t answered = 0;
+  size_t succeeded = 0;
 
-  // start sequence
-  if (!co_await this->read_escape_sequence(ctx, CODE_START)) {
-    co_return -1;
-  }
+  while (answered < count) {
+    // Fill the window
+    while (sent < count && sent - answered < this->pipeline_depth_) {
+      co_await this->write_array_coro(ctx, queries[sent].frame->data(), queries[sent].frame->size());
+      ++sent;
+    }
 
-  // command
-  {
-    std::array<uint8_t, sizeof(cmd_t)> buf;
-    if (!co_await this->read_array_coro(ctx, buf.data(), buf.size())) {
-      ESP_LOGW(TAG, "Failed to read command");
-      co_return -1;
+    // Queries are answered in order, only the oldest outstanding one can time out
+    Query *oldest = nullptr;
+    for (size_t i = 0; i < sent; ++i) {
+      if (!queries[i].done) {
+        oldest = &queries[i];
+        break;
+      }
     }
+    auto timeout = oldest->acked ? READ_TIMEOUT_MS : ACK_TIMEOUT_MS;
 
+    auto code = co_await this->read_message_code(ctx, timeout);
     cmd_t received_cmd;
-    for (auto b : buf) {
-      received_cmd = (received_cmd << 8) | b;
-      cksum += b;
+    if (code < 0 || (code == CODE_START && !co_await this->read_command(ctx, &received_cmd))) {
+      // Give up on it and resync on the next message
+      ESP_LOGW(TAG, "No %s for query %x", oldest->acked ? "response" : "ACK", oldest->cmd);
+      oldest->done = true;
+      ++answered;
+      continue;
     }
 
-    cmd_t expected_cmd = cmd + 1;
-    if (received_cmd != expected_cmd) {
-      ESP_LOGW(TAG, "Command mismatch: %x != %x", expected_cmd, received_cmd);
+    if (code == CODE_ACK) {
+      // ACKs carry no command, they come in the order the queries were sent
+      Query *query = nullptr;
+      for (size_t i = 0; i < sent; ++i) {
+        if (!queries[i].done && !queries[i].acked) {
+          query = &queries[i];
+          break;
+        }
+      }
+      if (query != nullptr) {
+        query->acked = true;
+      } else {
+        ESP_LOGW(TAG, "Unexpected ACK");
+      }
+      continue;
+    }
+
+    // Response, match it to an outstanding query by command
+    Query *query = nullptr;
+    for (size_t i = 0; i < sent; ++i) {
+      if (!queries[i].done && queries[i].cmd + 1 == received_cmd) {
+        query = &queries[i];
+        break;
+      }
+    }
+    if (query == nullptr) {
+      ESP_LOGW(TAG, "Unexpected response %x", received_cmd);
+      co_await this->discard_response(ctx, received_cmd);
+      continue;
+    }
+
+    // The unit answers in order, earlier queries still outstanding were dropped
+    for (auto *skipped = oldest; skipped != query; ++skipped) {
+      if (!skipped->done) {
+        ESP_LOGW(TAG, "No response for query %x", skipped->cmd);
+        skipped->done = true;
+        ++answered;
+      }
+    }
+
+    // A response implies the query was received even if its ACK got lost
+    query->acked = true;
+    auto len = co_await this->read_response_payload(ctx, received_cmd, query->data, query->data_len);
+    query->done = true;
+    ++answered;
+
+    if (len < 0) {
+      ESP_LOGW(TAG, "Failed to read response");
+      continue;
+    }
+
+    if (len != query->data_len) {
+      ESP_LOGE(TAG, "Unexpected response size: %d != %d", len, query->data_len);
+      continue;
+    }
+
+    query->ok = true;
+    ++succeeded;
+  }
+
+  co_return succeeded;
+}
+
+Coroutine<void> ZehnderComfoAirComponent::discard_response(Context& ctx, cmd_t cmd) {
+  std::array<uint8_t, UINT8_MAX> data;
+  co_await this->read_response_payload(ctx, cmd, data.data(), data.size());
+}
+
+Coroutine<int> ZehnderComfoAirComponent::read_message_code(Context& ctx, uint32_t timeout) {
+  uint8_t b;
+
+  while (true) {
+    do {
+      if (!co_await this->read_byte_coro(ctx, &b, timeout)) {
+        co_return -1;
+      }
+    } while (b != CODE_ESCAPE);
+
+    if (!co_await this->read_byte_coro(ctx, &b, timeout)) {
       co_return -1;
     }
+
+    if (b == CODE_ACK || b == CODE_START) {
+      co_return b;
+    }
+  }
+}
+
+Coroutine<bool> ZehnderComfoAirComponent::read_command(Context& ctx, cmd_t *cmd) {
+  std::array<uint8_t, sizeof(cmd_t)> buf;
+  if (!co_await this->read_array_coro(ctx, buf.data(), buf.size())) {
+    ESP_LOGW(TAG, "Failed to read command");
+    co_return false;
+  }
+
+  *cmd = 0;
+  for (auto b : buf) {
+    *cmd = (*cmd << 8) | b;
+  }
+
+  co_return true;
+}
+
+Coroutine<int> ZehnderComfoAirComponent::read_response_payload(Context& ctx, cmd_t cmd, uint8_t *data, uint8_t data_len) {
+  uint8_t cksum = CKSUM_INIT;
+  for (size_t i = 0; i < sizeof(cmd_t); ++i) {
+    cksum += (cmd >> (8*i)) & 0xFF;
   }
 
   // data length
@@ -213,32 +442,21 @@ Coroutine<int> ZehnderComfoAirComponent::read_response(Context& ctx, cmd_t cmd,
   }
 
   // ACK
-  this->send_ack();
+  co_await this->send_ack(ctx);
 
   co_return received_data_len;
 }
 
 Coroutine<bool> ZehnderComfoAirComponent::query_data(Context& ctx, cmd_t cmd, uint8_t *data, uint8_t data_len) {
-  if (!co_await this->send_command(ctx, cmd)) {
-    co_return 0;
-  }
-
-  auto len = co_await this->read_response(ctx, cmd, data, data_len);
-  if (len < 0) {
-    ESP_LOGW(TAG, "Failed to read response");
-    co_return 0;
-  }
+  auto frame = make_query_frame(cmd);
+  Query query{&frame, cmd, data, data_len};
 
-  if (len != data_len) {
-    ESP_LOGE(TAG, "Unexpected response size: %d != %d", len, data_len);
-    co_return 0;
-  }
-
-  co_return len;
+  co_return co_await this->query_pipelined(ctx, &query, 1) == 1;
 }
 
-void ZehnderComfoAirComponent::send_ack() {
-  this->write_array(std::to_array<uint8_t>({CODE_ESCAPE, CODE_ACK}));
+Coroutine<void> ZehnderComfoAirComponent::send_ack(Context& ctx) {
+  static constexpr auto ACK = std::to_array<uint8_t>({CODE_ESCAPE, CODE_ACK});
+  co_await this->write_array_coro(ctx, ACK.data(), ACK.size());
 }
 
 Coroutine<bool> ZehnderComfoAirComponent::read_ack(Context& ctx) {
@@ -279,85 +497,255 @@ Coroutine<bool> ZehnderComfoAirComponent::read_escape_sequence(Context& ctx, uin
   co_return true;
 }
 
-float ZehnderComfoAirComponent::parse_temperature(uint8_t byte) {
-  int raw = byte;
-  if (raw >= 128) raw -= 256;
-
-  return static_cast<float>(raw) / 2 - 20;
+Coroutine<void> ZehnderComfoAirComponent::wait_until(Context&, uint32_t deadline) {
+  while (static_cast<int32_t>(millis() - deadline) < 0) {
+    co_await std::suspend_always{};
+  }
 }
 
-uint8_t ZehnderComfoAirComponent::serialize_temperature(float t) {
-  return std::round((t + 20) * 2);
-}
+Coroutine<void> ZehnderComfoAirComponent::poll(Context& ctx) {
+  // Poll plan is fixed at compile time, only datapoints with configured entities are queried
+  std::array<Query, MAX_POLL_QUERIES> queries;
+  size_t count = 0;
 
-Coroutine<void> ZehnderComfoAirComponent::update_temperatures(Context& ctx) {
-#ifdef USE_SENSOR
-  std::array<uint8_t, 9> data;
-  if (!co_await this->query_data(ctx, 0x00D1, data.data(), data.size())) {
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_TEMPERATURES
+  std::array<uint8_t, TEMPERATURES_DATA_SIZE> temperatures;
+  auto& temperatures_query = queries[count++] = {&TEMPERATURES_QUERY_FRAME, CMD_TEMPERATURES, temperatures.data(), TEMPERATURES_DATA_SIZE};
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_FANS
+  std::array<uint8_t, FANS_DATA_SIZE> fans;
+  auto& fans_query = queries[count++] = {&FANS_QUERY_FRAME, CMD_FANS, fans.data(), FANS_DATA_SIZE};
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_BYPASS_STATUS
+  std::array<uint8_t, BYPASS_STATUS_DATA_SIZE> bypass_status;
+  auto& bypass_status_query = queries[count++] = {&BYPASS_STATUS_QUERY_FRAME, CMD_BYPASS_STATUS, bypass_status.data(), BYPASS_STATUS_DATA_SIZE};
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_FAULTS
+  std::array<uint8_t, FAULTS_DATA_SIZE> faults;
+  auto& faults_query = queries[count++] = {&FAULTS_QUERY_FRAME, CMD_FAULTS, faults.data(), FAULTS_DATA_SIZE};
+#endif
+
+  if (count == 0) {
+    co_return;
+  }
+
+  auto start_time = millis();
+  auto succeeded = co_await this->query_pipelined(ctx, queries.data(), count);
+  ESP_LOGD(TAG, "Poll cycle: %zu/%zu queries in %" PRIu32 " ms, %" PRIu32 " us blocked in TX", succeeded, count,
+           millis() - start_time, this->take_tx_blocked_us());
+
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_TEMPERATURES
+  if (temperatures_query.ok) {
+    this->publish_temperatures(temperatures.data());
+  } else {
     ESP_LOGW(TAG, "Failed to get temperatures");
+  }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_FANS
+  if (fans_query.ok) {
+    this->publish_fans(fans.data());
+  } else {
+    ESP_LOGW(TAG, "Failed to get fans");
+  }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_BYPASS_STATUS
+  if (bypass_status_query.ok) {
+    this->publish_bypass_status(bypass_status.data());
+  } else {
+    ESP_LOGW(TAG, "Failed to get bypass status");
+  }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_FAULTS
+  if (faults_query.ok) {
+    this->publish_faults(faults.data());
+  } else {
+    ESP_LOGW(TAG, "Failed to get faults");
+  }
+#endif
+}
+
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTICS
+Coroutine<void> ZehnderComfoAirComponent::poll_diagnostics(Context& ctx) {
+  // Diagnostic datapoints are queried on request only, never as part of the regular poll
+  std::array<Query, MAX_DIAGNOSTIC_QUERIES> queries;
+  size_t count = 0;
+
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_BYPASS_CONTROL
+  std::array<uint8_t, BYPASS_CONTROL_DATA_SIZE> bypass_control;
+  auto& bypass_control_query = queries[count++] = {&BYPASS_CONTROL_QUERY_FRAME, CMD_BYPASS_CONTROL, bypass_control.data(), BYPASS_CONTROL_DATA_SIZE};
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_FAULTS
+  std::array<uint8_t, FAULTS_DATA_SIZE> faults;
+  auto& faults_query = queries[count++] = {&FAULTS_QUERY_FRAME, CMD_FAULTS, faults.data(), FAULTS_DATA_SIZE};
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_OPERATING_HOURS
+  std::array<uint8_t, OPERATING_HOURS_DATA_SIZE> operating_hours;
+  auto& operating_hours_query = queries[count++] = {&OPERATING_HOURS_QUERY_FRAME, CMD_OPERATING_HOURS, operating_hours.data(), OPERATING_HOURS_DATA_SIZE};
+#endif
+
+  if (count == 0) {
     co_return;
   }
 
-  auto flags = data[5];
+  auto succeeded = co_await this->query_pipelined(ctx, queries.data(), count);
+  ESP_LOGD(TAG, "Diagnostics: %zu/%zu queries, %" PRIu32 " us blocked in TX", succeeded, count,
+           this->take_tx_blocked_us());
 
-  auto update_sensor = [flags, this](sensor::Sensor *sensor, uint8_t flag_mask, uint8_t raw_value) {
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_BYPASS_CONTROL
+  if (bypass_control_query.ok) {
+    this->publish_bypass_control(bypass_control.data());
+  } else {
+    ESP_LOGW(TAG, "Failed to get bypass control status");
+  }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_FAULTS
+  if (faults_query.ok) {
+    this->publish_faults(faults.data());
+  } else {
+    ESP_LOGW(TAG, "Failed to get faults");
+  }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_OPERATING_HOURS
+  if (operating_hours_query.ok) {
+    this->publish_operating_hours(operating_hours.data());
+  } else {
+    ESP_LOGW(TAG, "Failed to get operating hours");
+  }
+#endif
+}
+#endif
+
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_TEMPERATURES
+void ZehnderComfoAirComponent::publish_temperatures(const uint8_t *data) {
+  [[maybe_unused]] auto flags = data[5];
+
+  // Comfort temperature number alone enables this datapoint, without the sensor platform
+#ifdef USE_SENSOR
+  [[maybe_unused]] auto update_sensor = [flags](sensor::Sensor *sensor, uint8_t flag_mask, uint8_t raw_value) {
     if (sensor == nullptr) return;
     if (flags & flag_mask) {
-        auto t = this->parse_temperature(raw_value);
-        sensor->publish_state(t);
+        sensor->publish_state(Temperature::from_raw(raw_value).to_float());
     } else {
         sensor->publish_state(NAN);
     }
   };
+#endif
 
+#ifdef USE_ZEHNDER_COMFOAIR_COMFORT_TEMPERATURE
   if (this->comfort_temperature_pending_updates_ == 0 && this->comfort_temperature_number_ != nullptr) {
-    auto comfort_t = this->parse_temperature(data[0]);
-    if (!this->comfort_temperature_number_->has_state() || this->comfort_temperature_number_->state != comfort_t) {
-        this->comfort_temperature_number_->publish_state(comfort_t);
+    auto comfort_t = Temperature::from_raw(data[0]);
+    if (!this->comfort_temperature_number_->has_state() || this->comfort_temperature_ != comfort_t) {
+        this->comfort_temperature_number_->publish_state(comfort_t.to_float());
     }
   }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_OUTSIDE_TEMPERATURE
   update_sensor(this->outside_temperature_sensor_, OUTSIDE_TEMP_MASK, data[1]);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_SUPPLY_TEMPERATURE
   update_sensor(this->supply_temperature_sensor_, SUPPLY_TEMP_MASK, data[2]);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXTRACT_TEMPERATURE
   update_sensor(this->extract_temperature_sensor_, EXTRACT_TEMP_MASK, data[3]);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXHAUST_TEMPERATURE
   update_sensor(this->exhaust_temperature_sensor_, EXHAUST_TEMP_MASK, data[4]);
 #endif
 
-  co_return;
+#ifdef USE_ZEHNDER_COMFOAIR_HEAT_RECOVERY_EFFICIENCY
+  if (this->heat_recovery_efficiency_sensor_ != nullptr) {
+    constexpr uint8_t required_mask = OUTSIDE_TEMP_MASK | SUPPLY_TEMP_MASK | EXTRACT_TEMP_MASK;
+    auto outside_t = Temperature::from_raw(data[1]);
+    int32_t gain = Temperature::from_raw(data[2]) - outside_t;
+    int32_t span = Temperature::from_raw(data[3]) - outside_t;
+
+    // Ratio of half-degree steps is meaningless when indoor and outdoor are close
+    if ((flags & required_mask) != required_mask || std::abs(span) < EFFICIENCY_MIN_SPAN) {
+      this->heat_recovery_efficiency_sensor_->publish_state(NAN);
+    } else {
+      if (span < 0) {
+        gain = -gain;
+        span = -span;
+      }
+      // Percent, rounded half away from zero
+      int32_t scaled = 100 * gain;
+      int32_t efficiency = (scaled >= 0 ? scaled + span / 2 : scaled - span / 2) / span;
+      this->heat_recovery_efficiency_sensor_->publish_state(efficiency);
+    }
+  }
+#endif
 }
+#endif
 
-Coroutine<void> ZehnderComfoAirComponent::update_bypass_status(Context& ctx) {
-#ifdef USE_SENSOR
-  if (this->bypass_status_sensor_ == nullptr) {
-    co_return;
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_FANS
+void ZehnderComfoAirComponent::publish_fans(const uint8_t *data) {
+  [[maybe_unused]] auto update_speed = [](sensor::Sensor *sensor, uint8_t hi, uint8_t lo) {
+    if (sensor == nullptr) return;
+    uint16_t period = (hi << 8) | lo;
+    sensor->publish_state(period != 0 ? FAN_SPEED_FACTOR / period : 0);
+  };
+
+#ifdef USE_ZEHNDER_COMFOAIR_SUPPLY_FAN_DUTY
+  if (this->supply_fan_duty_sensor_ != nullptr) {
+    this->supply_fan_duty_sensor_->publish_state(data[0]);
+  }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXHAUST_FAN_DUTY
+  if (this->exhaust_fan_duty_sensor_ != nullptr) {
+    this->exhaust_fan_duty_sensor_->publish_state(data[1]);
   }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_SUPPLY_FAN_SPEED
+  update_speed(this->supply_fan_speed_sensor_, data[2], data[3]);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXHAUST_FAN_SPEED
+  update_speed(this->exhaust_fan_speed_sensor_, data[4], data[5]);
+#endif
+}
+#endif
 
-  std::array<uint8_t, 4> data;
-  if (!co_await this->query_data(ctx, 0x000D, data.data(), data.size())) {
-    ESP_LOGW(TAG, "Failed to get bypass status");
-    co_return;
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_BYPASS_STATUS
+void ZehnderComfoAirComponent::publish_bypass_status(const uint8_t *data) {
+  if (this->bypass_status_sensor_ == nullptr) {
+    return;
   }
 
   auto bypass_status = data[0];
   if (bypass_status != 0xFF) {
     this->bypass_status_sensor_->publish_state(bypass_status);
   }
+}
 #endif
 
-  co_return;
-}
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_BYPASS_CONTROL
+void ZehnderComfoAirComponent::publish_bypass_control(const uint8_t *data) {
+  ESP_LOGD(TAG, "Bypass control status: %x %x %x %x %x %x %x", data[0], data[1], data[2], data[3], data[4], data[5], data[6]);
 
-Coroutine<void> ZehnderComfoAirComponent::update_bypass_control_status(Context& ctx) {
-  std::array<uint8_t, 7> data;
-  if (!co_await this->query_data(ctx, 0x00DF, data.data(), data.size())) {
-    ESP_LOGW(TAG, "Failed to get bypass control status");
-    co_return;
+#ifdef USE_ZEHNDER_COMFOAIR_BYPASS_FACTOR
+  if (this->bypass_factor_sensor_ != nullptr) {
+    this->bypass_factor_sensor_->publish_state(data[2]);
   }
+#endif
+}
+#endif
 
-  ESP_LOGD(TAG, "Bypass control status: %x %x %x %x %x %x %x", data[0], data[1], data[2], data[3], data[4], data[5], data[6]);
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_OPERATING_HOURS
+void ZehnderComfoAirComponent::publish_operating_hours(const uint8_t *data) {
+#ifdef USE_ZEHNDER_COMFOAIR_FILTER_HOURS
+  if (this->filter_hours_sensor_ != nullptr) {
+    uint16_t filter_hours = (data[15] << 8) | data[16];
+    this->filter_hours_sensor_->publish_state(filter_hours);
+  }
+#endif
 }
+#endif
 
+#ifdef USE_ZEHNDER_COMFOAIR_LEVEL
 Coroutine<void> ZehnderComfoAirComponent::update_levels(Context& ctx) {
-#ifdef USE_NUMBER
+  if (this->level_number_ == nullptr) {
+    co_return;
+  }
+
   std::array<uint8_t, 14> data;
   if (!co_await this->query_data(ctx, 0x00CD, data.data(), data.size())) {
     ESP_LOGW(TAG, "Failed to get ventilation levels");
@@ -369,19 +757,12 @@ Coroutine<void> ZehnderComfoAirComponent::update_levels(Context& ctx) {
     uint8_t level = raw_level - 1;
     this->level_number_->publish_state(level);
   }
-#endif
-
-  co_return;
 }
+#endif
 
-Coroutine<void> ZehnderComfoAirComponent::update_faults(Context& ctx) {
-  std::array<uint8_t, 17> data;
-  if (!co_await this->query_data(ctx, 0x00D9, data.data(), data.size())) {
-    ESP_LOGW(TAG, "Failed to get faults");
-    co_return;
-  }
-
-#ifdef USE_BINARY_SENSOR
+#if defined(USE_ZEHNDER_COMFOAIR_QUERY_FAULTS) || defined(USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_FAULTS)
+void ZehnderComfoAirComponent::publish_faults(const uint8_t *data) {
+#ifdef USE_ZEHNDER_COMFOAIR_FILTER_FULL
   if (this->filter_full_binary_sensor_ != nullptr) {
     auto filter_full = static_cast<bool>(data[8]);
     this->filter_full_binary_sensor_->publish_state(filter_full);
@@ -389,8 +770,31 @@ Coroutine<void> ZehnderComfoAirComponent::update_faults(Context& ctx) {
 #endif
 
   ESP_LOGD(TAG, "Faults: A:%x E:%x EA:%x A(high):%x", data[0], data[1], data[9], data[15]);
+
+  // filter_full alone enables this datapoint, without the sensor platform
+#ifdef USE_SENSOR
+  [[maybe_unused]] auto update_code = [](sensor::Sensor *sensor, uint8_t code) {
+    if (sensor == nullptr) return;
+    sensor->publish_state(code);
+  };
+#endif
+
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_A
+  update_code(this->fault_a_sensor_, data[0]);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_E
+  update_code(this->fault_e_sensor_, data[1]);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_EA
+  update_code(this->fault_ea_sensor_, data[9]);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_A_HIGH
+  update_code(this->fault_a_high_sensor_, data[15]);
+#endif
 }
+#endif
 
+#ifdef USE_ZEHNDER_COMFOAIR_LEVEL
 Coroutine<void> ZehnderComfoAirComponent::apply_level(Context& ctx, uint8_t level) {
   uint8_t raw_level = level + 1;
   if (!co_await this->send_command(ctx, 0x0099, &raw_level, 1)) {
@@ -398,20 +802,137 @@ Coroutine<void> ZehnderComfoAirComponent::apply_level(Context& ctx, uint8_t leve
     co_return;
   }
 }
+#endif
 
-Coroutine<void> ZehnderComfoAirComponent::apply_comfort_temperature(Context& ctx, float t) {
-    uint8_t raw_temp = this->serialize_temperature(t);
+#ifdef USE_ZEHNDER_COMFOAIR_COMFORT_TEMPERATURE
+Coroutine<void> ZehnderComfoAirComponent::apply_comfort_temperature(Context& ctx, Temperature t) {
+    uint8_t raw_temp = t.raw();
     if (!co_await this->send_command(ctx, 0x00D3, &raw_temp, 1)) {
         ESP_LOGW(TAG, "Failed to apply comfort temperature");
         co_return;
     }
 }
+#endif
+
+#ifdef USE_ZEHNDER_COMFOAIR_TELEMETRY
+Coroutine<void> ZehnderComfoAirComponent::run_telemetry(Context& ctx) {
+  // Sample buffers live in the coroutine frame and the awaited coroutines reuse pooled frames,
+  // so after the first sample the loop does not touch the heap
+  std::array<Query, 2> queries;
+  size_t count = 0;
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_FANS
+  std::array<uint8_t, FANS_DATA_SIZE> fans;
+  auto& fans_query = queries[count++];
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_TEMPERATURES
+  std::array<uint8_t, TEMPERATURES_DATA_SIZE> temperatures;
+  auto& temperatures_query = queries[count++];
+#endif
+
+  uint32_t next_sample = millis();
+  while (this->is_telemetry_active()) {
+    co_await this->wait_until(ctx, next_sample);
+    next_sample += this->telemetry_interval_;
+
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_FANS
+    fans_query = {&FANS_QUERY_FRAME, CMD_FANS, fans.data(), FANS_DATA_SIZE};
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_TEMPERATURES
+    temperatures_query = {&TEMPERATURES_QUERY_FRAME, CMD_TEMPERATURES, temperatures.data(), TEMPERATURES_DATA_SIZE};
+#endif
+
+    bool ok = co_await this->query_pipelined(ctx, queries.data(), count) == count;
+    this->telemetry_tx_blocked_us_ += this->take_tx_blocked_us();
+    if (!ok) {
+      ESP_LOGW(TAG, "Failed to get telemetry sample");
+    }
+
+    // Publish the whole sample at once, skipping frames identical to the last published ones
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_FANS
+    if (fans_query.ok && (!this->telemetry_has_sample_ || fans != this->telemetry_fans_)) {
+      this->telemetry_fans_ = fans;
+      this->publish_fans(fans.data());
+    }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_TEMPERATURES
+    if (temperatures_query.ok && (!this->telemetry_has_sample_ || temperatures != this->telemetry_temperatures_)) {
+      this->telemetry_temperatures_ = temperatures;
+      this->publish_temperatures(temperatures.data());
+    }
+#endif
+    this->telemetry_has_sample_ = this->telemetry_has_sample_ || ok;
+
+    // Do not fall behind when the bus is slower than the interval
+    if (static_cast<int32_t>(millis() - next_sample) > 0) {
+      next_sample = millis();
+    }
+
+    // Let the queued commands through, continue the session after them
+    if (this->task_queue.size() > 1 && this->is_telemetry_active()) {
+      this->task_queue.enqueue([this](Context& ctx) -> Coroutine<void> {
+        co_await this->run_telemetry(ctx);
+      });
+      co_return;
+    }
+  }
+
+  ESP_LOGI(TAG, "Telemetry finished, %" PRIu32 " us blocked in TX", this->telemetry_tx_blocked_us_);
+  this->telemetry_enabled_ = false;
+  this->telemetry_running_ = false;
+
+  // Back to regular polling, refresh everything that was not streamed
+  this->update();
+}
+#endif
+
+uint32_t ZehnderComfoAirComponent::tx_queued_us(uint32_t now) const {
+  uint32_t elapsed_us = now - this->tx_last_write_at_;
+  return elapsed_us < this->tx_queued_us_ ? this->tx_queued_us_ - elapsed_us : 0;
+}
 
-Coroutine<bool> ZehnderComfoAirComponent::read_array_coro(Context&, uint8_t* data, size_t data_len) {
+size_t ZehnderComfoAirComponent::tx_fifo_available() const {
+  auto remaining_us = this->tx_queued_us(micros());
+  if (remaining_us == 0) {
+    return TX_FIFO_SIZE;
+  }
+
+  size_t pending = (remaining_us + this->tx_byte_time_us_ - 1) / this->tx_byte_time_us_;
+  return pending < TX_FIFO_SIZE ? TX_FIFO_SIZE - pending : 0;
+}
+
+uint32_t ZehnderComfoAirComponent::take_tx_blocked_us() {
+  auto blocked_us = this->tx_blocked_us_;
+  this->tx_blocked_us_ = 0;
+  return blocked_us;
+}
+
+Coroutine<void> ZehnderComfoAirComponent::write_array_coro(Context&, const uint8_t* data, size_t data_len) {
+  while (data_len > 0) {
+    // The UART does not report free TX space, so track the FIFO from the bytes written and the baud rate
+    auto len = std::min(this->tx_fifo_available(), data_len);
+    if (len == 0) {
+      co_await std::suspend_always{};
+      continue;
+    }
+
+    auto start_time = micros();
+    this->write_array(data, len);
+    auto end_time = micros();
+    this->tx_blocked_us_ += end_time - start_time;
+
+    this->tx_queued_us_ = this->tx_queued_us(end_time) + len * this->tx_byte_time_us_;
+    this->tx_last_write_at_ = end_time;
+
+    data += len;
+    data_len -= len;
+  }
+}
+
+Coroutine<bool> ZehnderComfoAirComponent::read_array_coro(Context&, uint8_t* data, size_t data_len, uint32_t timeout) {
   auto start_time = millis();
 
   while (static_cast<size_t>(this->available()) < data_len) {
-    if (millis() - start_time > READ_TIMEOUT_MS) {
+    if (millis() - start_time > timeout) {
       co_return false;
     }
     co_await std::suspend_always{};
@@ -426,5 +947,11 @@ void ZehnderComfoAirNumber::control(float value) {
 }
 #endif
 
+#if defined(USE_BUTTON) && defined(USE_ZEHNDER_COMFOAIR_DIAGNOSTICS)
+void ZehnderComfoAirButton::press_action() {
+  this->parent_->update_diagnostics();
+}
+#endif
+
 }  // namespace zehnder_comfoair
 }  // namespace esphome
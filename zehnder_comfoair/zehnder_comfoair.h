@@ -1,6 +1,9 @@
 #pragma once
 
 #include "coroutine.h"
+#include "temperature.h"
+
+#include <array>
 
 #include "esphome/core/defines.h"
 #ifdef USE_BINARY_SENSOR
@@ -29,68 +32,267 @@ class ZehnderComfoAirComponent : public uart::UARTDevice, public PollingComponen
     void update() override;
     void dump_config() override;
 
-#ifdef USE_SENSOR
+    // Setters and members exist only for entities present in the configuration,
+    // see USE_ZEHNDER_COMFOAIR_* defines emitted by the platforms
+#ifdef USE_ZEHNDER_COMFOAIR_BYPASS_STATUS
     void set_bypass_status_sensor(sensor::Sensor *bypass_status) { this->bypass_status_sensor_ = bypass_status; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_OUTSIDE_TEMPERATURE
     void set_outside_temperature_sensor(sensor::Sensor *outside_temperature) { this->outside_temperature_sensor_ = outside_temperature; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_SUPPLY_TEMPERATURE
     void set_supply_temperature_sensor(sensor::Sensor *supply_temperature) { this->supply_temperature_sensor_ = supply_temperature; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXTRACT_TEMPERATURE
     void set_extract_temperature_sensor(sensor::Sensor *extract_temperature) { this->extract_temperature_sensor_ = extract_temperature; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXHAUST_TEMPERATURE
     void set_exhaust_temperature_sensor(sensor::Sensor *exhaust_temperature) { this->exhaust_temperature_sensor_ = exhaust_temperature; }
 #endif
+#ifdef USE_ZEHNDER_COMFOAIR_HEAT_RECOVERY_EFFICIENCY
+    void set_heat_recovery_efficiency_sensor(sensor::Sensor *heat_recovery_efficiency) { this->heat_recovery_efficiency_sensor_ = heat_recovery_efficiency; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_SUPPLY_FAN_DUTY
+    void set_supply_fan_duty_sensor(sensor::Sensor *supply_fan_duty) { this->supply_fan_duty_sensor_ = supply_fan_duty; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXHAUST_FAN_DUTY
+    void set_exhaust_fan_duty_sensor(sensor::Sensor *exhaust_fan_duty) { this->exhaust_fan_duty_sensor_ = exhaust_fan_duty; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_SUPPLY_FAN_SPEED
+    void set_supply_fan_speed_sensor(sensor::Sensor *supply_fan_speed) { this->supply_fan_speed_sensor_ = supply_fan_speed; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXHAUST_FAN_SPEED
+    void set_exhaust_fan_speed_sensor(sensor::Sensor *exhaust_fan_speed) { this->exhaust_fan_speed_sensor_ = exhaust_fan_speed; }
+#endif
 
-#ifdef USE_BINARY_SENSOR
+#ifdef USE_ZEHNDER_COMFOAIR_BYPASS_FACTOR
+    void set_bypass_factor_sensor(sensor::Sensor *bypass_factor) { this->bypass_factor_sensor_ = bypass_factor; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_A
+    void set_fault_a_sensor(sensor::Sensor *fault_a) { this->fault_a_sensor_ = fault_a; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_E
+    void set_fault_e_sensor(sensor::Sensor *fault_e) { this->fault_e_sensor_ = fault_e; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_EA
+    void set_fault_ea_sensor(sensor::Sensor *fault_ea) { this->fault_ea_sensor_ = fault_ea; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_A_HIGH
+    void set_fault_a_high_sensor(sensor::Sensor *fault_a_high) { this->fault_a_high_sensor_ = fault_a_high; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FILTER_HOURS
+    void set_filter_hours_sensor(sensor::Sensor *filter_hours) { this->filter_hours_sensor_ = filter_hours; }
+#endif
+
+#ifdef USE_ZEHNDER_COMFOAIR_FILTER_FULL
     void set_filter_full_binary_sensor(binary_sensor::BinarySensor *filter_full) { this->filter_full_binary_sensor_ = filter_full; }
 #endif
 
-#ifdef USE_NUMBER
+#ifdef USE_ZEHNDER_COMFOAIR_LEVEL
     void set_level_number(number::Number *level) { this->level_number_ = level; }
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_COMFORT_TEMPERATURE
     void set_comfort_temperature_number(number::Number *comfort_temperature_number) { this->comfort_temperature_number_ = comfort_temperature_number; }
 #endif
 
+    void set_pipeline_depth(uint8_t pipeline_depth) { this->pipeline_depth_ = pipeline_depth; }
+    void set_telemetry_interval(uint32_t telemetry_interval) { this->telemetry_interval_ = telemetry_interval; }
+
+#ifdef USE_ZEHNDER_COMFOAIR_TELEMETRY
+    // Stream fans and temperatures every telemetry_interval for the given duration (ms),
+    // regular polling is paused for the session and resumes once it ends
+    void start_telemetry(uint32_t duration);
+    void stop_telemetry();
+    bool is_telemetry_active() const;
+#endif
+
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTICS
+    // Query the configured diagnostic datapoints once, they are not part of the regular poll
+    void update_diagnostics();
+#endif
+
   protected:
     using cmd_t = uint16_t;
+    // Complete frame of a query without data: start, command, length, checksum, end
+    using query_frame_t = std::array<uint8_t, 8>;
+
+    static constexpr uint32_t READ_TIMEOUT_MS = 10000;
 
-    Coroutine<bool> read_array_coro(Context& ctx, uint8_t* data, size_t data_len);
-    Coroutine<bool> read_byte_coro(Context& ctx, uint8_t* data) { return this->read_array_coro(ctx, data, 1); }
+    Coroutine<bool> read_array_coro(Context& ctx, uint8_t* data, size_t data_len, uint32_t timeout = READ_TIMEOUT_MS);
+    Coroutine<bool> read_byte_coro(Context& ctx, uint8_t* data, uint32_t timeout = READ_TIMEOUT_MS) {
+      return this->read_array_coro(ctx, data, 1, timeout);
+    }
+    // Write only as much as the TX FIFO takes without blocking, suspend until it drains for the rest
+    Coroutine<void> write_array_coro(Context& ctx, const uint8_t* data, size_t data_len);
+    size_t tx_fifo_available() const;
+    // Transmit time still queued in the TX FIFO at the given time, in us
+    uint32_t tx_queued_us(uint32_t now) const;
+    // Return the time spent inside UART writes since the last call, each task reports its own
+    uint32_t take_tx_blocked_us();
+
+    struct Query {
+      const query_frame_t *frame;
+      cmd_t cmd;
+      uint8_t *data;
+      uint8_t data_len;
+      // Filled in by query_pipelined
+      bool acked = false;
+      bool done = false;
+      bool ok = false;
+    };
 
     Coroutine<bool> send_command(Context& ctx, cmd_t cmd, const uint8_t *data = nullptr, size_t data_len = 0);
-    Coroutine<int> read_response(Context& ctx, cmd_t cmd, uint8_t *data, uint8_t data_len);
+    Coroutine<int> read_message_code(Context& ctx, uint32_t timeout = READ_TIMEOUT_MS);
+    Coroutine<bool> read_command(Context& ctx, cmd_t *cmd);
+    Coroutine<int> read_response_payload(Context& ctx, cmd_t cmd, uint8_t *data, uint8_t data_len);
+    // Read and ACK a response nobody waits for, so the unit does not repeat it
+    Coroutine<void> discard_response(Context& ctx, cmd_t cmd);
 
     Coroutine<bool> query_data(Context& ctx, cmd_t cmd, uint8_t *data, uint8_t data_len);
+    // Send up to pipeline_depth_ queries ahead, matching ACKs by order and responses by command.
+    // The oldest outstanding query fails when its ACK (ACK_TIMEOUT_MS) or response (READ_TIMEOUT_MS)
+    // does not arrive, the rest are still sent. Returns the number of successful queries
+    Coroutine<size_t> query_pipelined(Context& ctx, Query *queries, size_t count);
 
-    void send_ack();
+    Coroutine<void> send_ack(Context& ctx);
     Coroutine<bool> read_ack(Context& ctx);
 
     Coroutine<bool> read_escape_sequence(Context& ctx, uint8_t byte, bool skip_mismatched = false);
 
-    float parse_temperature(uint8_t byte);
-    uint8_t serialize_temperature(float t);
+    Coroutine<void> wait_until(Context& ctx, uint32_t deadline);
+
+    Coroutine<void> poll(Context& ctx);
 
-    Coroutine<void> update_temperatures(Context& ctx);
-    Coroutine<void> update_bypass_status(Context& ctx);
-    Coroutine<void> update_bypass_control_status(Context& ctx);
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_TEMPERATURES
+    void publish_temperatures(const uint8_t *data);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_FANS
+    void publish_fans(const uint8_t *data);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_QUERY_BYPASS_STATUS
+    void publish_bypass_status(const uint8_t *data);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTICS
+    Coroutine<void> poll_diagnostics(Context& ctx);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_BYPASS_CONTROL
+    void publish_bypass_control(const uint8_t *data);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_OPERATING_HOURS
+    void publish_operating_hours(const uint8_t *data);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_LEVEL
     Coroutine<void> update_levels(Context& ctx);
-    Coroutine<void> update_faults(Context& ctx);
     Coroutine<void> apply_level(Context& ctx, uint8_t level);
-    Coroutine<void> apply_comfort_temperature(Context& ctx, float t);
+#endif
+#if defined(USE_ZEHNDER_COMFOAIR_QUERY_FAULTS) || defined(USE_ZEHNDER_COMFOAIR_DIAGNOSTIC_FAULTS)
+    void publish_faults(const uint8_t *data);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_COMFORT_TEMPERATURE
+    Coroutine<void> apply_comfort_temperature(Context& ctx, Temperature t);
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_TELEMETRY
+    Coroutine<void> run_telemetry(Context& ctx);
+#endif
 
-#ifdef USE_SENSOR
-    sensor::Sensor *bypass_status_sensor_;
-    sensor::Sensor *outside_temperature_sensor_;
-    sensor::Sensor *supply_temperature_sensor_;
-    sensor::Sensor *extract_temperature_sensor_;
-    sensor::Sensor *exhaust_temperature_sensor_;
+#ifdef USE_ZEHNDER_COMFOAIR_BYPASS_STATUS
+    sensor::Sensor *bypass_status_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_OUTSIDE_TEMPERATURE
+    sensor::Sensor *outside_temperature_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_SUPPLY_TEMPERATURE
+    sensor::Sensor *supply_temperature_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXTRACT_TEMPERATURE
+    sensor::Sensor *extract_temperature_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXHAUST_TEMPERATURE
+    sensor::Sensor *exhaust_temperature_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_HEAT_RECOVERY_EFFICIENCY
+    sensor::Sensor *heat_recovery_efficiency_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_SUPPLY_FAN_DUTY
+    sensor::Sensor *supply_fan_duty_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXHAUST_FAN_DUTY
+    sensor::Sensor *exhaust_fan_duty_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_SUPPLY_FAN_SPEED
+    sensor::Sensor *supply_fan_speed_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_EXHAUST_FAN_SPEED
+    sensor::Sensor *exhaust_fan_speed_sensor_ = nullptr;
 #endif
 
-#ifdef USE_BINARY_SENSOR
-    binary_sensor::BinarySensor *filter_full_binary_sensor_;
+#ifdef USE_ZEHNDER_COMFOAIR_BYPASS_FACTOR
+    sensor::Sensor *bypass_factor_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_A
+    sensor::Sensor *fault_a_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_E
+    sensor::Sensor *fault_e_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_EA
+    sensor::Sensor *fault_ea_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FAULT_A_HIGH
+    sensor::Sensor *fault_a_high_sensor_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_FILTER_HOURS
+    sensor::Sensor *filter_hours_sensor_ = nullptr;
 #endif
 
-#ifdef USE_NUMBER
-    number::Number *level_number_;
-    number::Number *comfort_temperature_number_;
+#ifdef USE_ZEHNDER_COMFOAIR_FILTER_FULL
+    binary_sensor::BinarySensor *filter_full_binary_sensor_ = nullptr;
+#endif
+
+#ifdef USE_ZEHNDER_COMFOAIR_LEVEL
+    number::Number *level_number_ = nullptr;
+#endif
+#ifdef USE_ZEHNDER_COMFOAIR_COMFORT_TEMPERATURE
+    number::Number *comfort_temperature_number_ = nullptr;
 #endif
 
     int comfort_temperature_pending_updates_ = 0;
+#ifdef USE_ZEHNDER_COMFOAIR_COMFORT_TEMPERATURE
+    // Fixed point copy of the comfort temperature number state
+    Temperature comfort_temperature_;
+#endif
+
+#ifdef USE_ZEHNDER_COMFOAIR_DIAGNOSTICS
+    bool diagnostics_pending_ = false;
+#endif
+
+    // Time to transmit a byte, in us
+    uint32_t tx_byte_time_us_ = 1042;
+    // Time of the last write and the transmit time still queued in the TX FIFO then, in us.
+    // Only elapsed time is compared, so a long idle line never looks busy
+    uint32_t tx_last_write_at_ = 0;
+    uint32_t tx_queued_us_ = 0;
+    // Time spent inside UART writes since the last report, in us
+    uint32_t tx_blocked_us_ = 0;
+
+    // Queries in flight at once, 1 waits for every response before sending the next query
+    uint8_t pipeline_depth_ = 1;
+
+    uint32_t telemetry_interval_ = 1000;
+#ifdef USE_ZEHNDER_COMFOAIR_TELEMETRY
+    uint32_t telemetry_start_ = 0;
+    uint32_t telemetry_duration_ = 0;
+    // Session is requested
+    bool telemetry_enabled_ = false;
+    // Sampling task is in the queue
+    bool telemetry_running_ = false;
+    // Last published samples, identical frames are not published again
+    std::array<uint8_t, 6> telemetry_fans_{};
+    std::array<uint8_t, 9> telemetry_temperatures_{};
+    bool telemetry_has_sample_ = false;
+    // Time spent inside UART writes during the session, in us
+    uint32_t telemetry_tx_blocked_us_ = 0;
+#endif
 
     Queue task_queue;
 };